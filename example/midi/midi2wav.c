@@ -0,0 +1,818 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mlws_audio.h"
+
+// Offline Standard MIDI File (format 0/1) to WAV renderer
+//
+// Usage: midi2wav [-o out.wav] [-r rate] [-v voices] [-j jobs] in.mid [more.mid ...]
+// With several inputs each one is written next to it as .wav, files are
+// spread over jobs threads, every thread owns one Engine.
+//
+// Mapping:
+//  - note on/off -> voice allocation, velocity -> Voice.gain
+//  - pitch bend (+-2 semitones) -> osc increment
+//  - CC7 volume, CC11 expression -> Voice.gain
+//  - CC74 brightness -> filter cutoff, CC71 resonance -> filter damping
+//  - CC64 sustain pedal, CC120/123 all sound/notes off
+// Channel 10 (percussion) is skipped, there is no drum kit.
+
+#define DEFAULT_SAMPLE_RATE 44100
+#define DEFAULT_VOICES 32
+#define MAX_VOICES 256
+#define MAX_JOBS 64
+#define BLOCK_SIZE 512
+#define EVENT_CAPACITY 1024
+#define TAIL_MAX_SEC 10
+#define DRUM_CHANNEL 9
+
+#define META_TEMPO 0xFF // stored in MidiEvent.status, tempo in .tempo
+
+typedef struct
+{
+    u64 tick;
+    u64 time; // sample time, filled in after merging
+    u32 order;
+    u32 tempo; // us per quarter note
+    u8 status;
+    u8 data1;
+    u8 data2;
+} MidiEvent;
+
+typedef struct
+{
+    MidiEvent *events;
+    int count;
+    int capacity;
+    u16 division;
+} MidiSong;
+
+// ---------------------------------------------------------------------
+// SMF parsing
+
+static u32 read_be(const u8 *p, int bytes)
+{
+    u32 value = 0;
+    for (int i = 0; i < bytes; i++)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+// Returns 0 when running past end
+static int read_vlq(const u8 **p, const u8 *end, u32 *out)
+{
+    u32 value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        if (*p >= end)
+            return 0;
+        u8 b = *(*p)++;
+        value = (value << 7) | (b & 0x7F);
+        if (!(b & 0x80))
+        {
+            *out = value;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int song_push(MidiSong *song, const MidiEvent *ev)
+{
+    if (song->count == song->capacity)
+    {
+        int capacity = song->capacity ? song->capacity * 2 : 4096;
+        MidiEvent *events = realloc(song->events, sizeof(MidiEvent) * (size_t)capacity);
+        if (!events)
+            return 0;
+        song->events = events;
+        song->capacity = capacity;
+    }
+    song->events[song->count] = *ev;
+    song->events[song->count].order = (u32)song->count;
+    song->count++;
+    return 1;
+}
+
+static int parse_track(MidiSong *song, const u8 *p, const u8 *end)
+{
+    u64 tick = 0;
+    u8 running = 0;
+
+    while (p < end)
+    {
+        u32 delta;
+        if (!read_vlq(&p, end, &delta) || p >= end)
+            return 0;
+        tick += delta;
+
+        u8 status = *p;
+        if (status & 0x80)
+        {
+            p++;
+        }
+        else
+        {
+            if (!running)
+                return 0;
+            status = running; // running status
+        }
+
+        if (status == 0xFF)
+        {
+            u32 len;
+            if (p >= end)
+                return 0;
+            u8 type = *p++;
+            if (!read_vlq(&p, end, &len) || len > (u32)(end - p))
+                return 0;
+            if (type == 0x51 && len == 3)
+            {
+                MidiEvent ev = {0};
+                ev.tick = tick;
+                ev.status = META_TEMPO;
+                ev.tempo = read_be(p, 3);
+                if (!song_push(song, &ev))
+                    return 0;
+            }
+            else if (type == 0x2F)
+            {
+                return 1; // end of track
+            }
+            p += len;
+            continue;
+        }
+        if (status == 0xF0 || status == 0xF7)
+        {
+            u32 len;
+            if (!read_vlq(&p, end, &len) || len > (u32)(end - p))
+                return 0;
+            p += len; // sysex, ignored
+            continue;
+        }
+
+        running = status;
+        int data_len = ((status & 0xF0) == 0xC0 || (status & 0xF0) == 0xD0) ? 1 : 2;
+        if (end - p < data_len)
+            return 0;
+
+        MidiEvent ev = {0};
+        ev.tick = tick;
+        ev.status = status;
+        ev.data1 = p[0] & 0x7F;
+        ev.data2 = data_len == 2 ? (p[1] & 0x7F) : 0;
+        p += data_len;
+        if (!song_push(song, &ev))
+            return 0;
+    }
+    return 1;
+}
+
+static int compare_events(const void *a, const void *b)
+{
+    const MidiEvent *x = (const MidiEvent *)a;
+    const MidiEvent *y = (const MidiEvent *)b;
+    if (x->tick != y->tick)
+        return x->tick < y->tick ? -1 : 1;
+    return x->order < y->order ? -1 : (x->order > y->order);
+}
+
+// Merge tracks by tick and walk the tempo map to get sample times
+static void song_schedule(MidiSong *song, u32 sample_rate)
+{
+    qsort(song->events, (size_t)song->count, sizeof(MidiEvent), compare_events);
+
+    double tempo = 500000.0; // 120 bpm until told otherwise
+    double samples_per_tick;
+    double base_samples = 0.0;
+    u64 base_tick = 0;
+
+    if (song->division & 0x8000)
+    {
+        // SMPTE: -frames per second in the high byte, ticks per frame in the low one
+        int fps = -(i8)(song->division >> 8);
+        int ticks_per_frame = song->division & 0xFF;
+        samples_per_tick = (double)sample_rate / (fps * ticks_per_frame);
+    }
+    else
+    {
+        samples_per_tick = tempo * sample_rate / (1000000.0 * song->division);
+    }
+
+    for (int i = 0; i < song->count; i++)
+    {
+        MidiEvent *ev = &song->events[i];
+        double samples = base_samples + (double)(ev->tick - base_tick) * samples_per_tick;
+        ev->time = (u64)(samples + 0.5);
+
+        if (ev->status == META_TEMPO && !(song->division & 0x8000) && ev->tempo > 0)
+        {
+            base_samples = samples;
+            base_tick = ev->tick;
+            tempo = ev->tempo;
+            samples_per_tick = tempo * sample_rate / (1000000.0 * song->division);
+        }
+    }
+}
+
+static int song_load(MidiSong *song, const char *path, u32 sample_rate)
+{
+    memset(song, 0, sizeof(*song));
+
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    u8 *data = size > 0 ? malloc((size_t)size) : NULL;
+    if (!data || fread(data, 1, (size_t)size, f) != (size_t)size)
+    {
+        free(data);
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+
+    const u8 *p = data;
+    const u8 *end = data + size;
+    int ok = size >= 14 && memcmp(p, "MThd", 4) == 0 && read_be(p + 4, 4) >= 6;
+    if (ok)
+    {
+        u32 header_len = read_be(p + 4, 4);
+        int num_tracks = (int)read_be(p + 10, 2);
+        song->division = (u16)read_be(p + 12, 2);
+        ok = header_len <= (u32)(size - 8);
+        if (song->division & 0x8000)
+            ok = ok && (song->division & 0xFF) != 0 && -(i8)(song->division >> 8) > 0;
+        else
+            ok = ok && song->division != 0;
+        p += 8 + header_len;
+
+        for (int t = 0; ok && t < num_tracks && end - p >= 8; t++)
+        {
+            u32 len = read_be(p + 4, 4);
+            if (len > (u32)(end - p - 8))
+            {
+                ok = 0;
+                break;
+            }
+            // unknown chunk types are skipped, they do not count as tracks
+            if (memcmp(p, "MTrk", 4) == 0)
+                ok = parse_track(song, p + 8, p + 8 + len);
+            else
+                t--;
+            p += 8 + len;
+        }
+    }
+    free(data);
+
+    if (!ok)
+    {
+        free(song->events);
+        song->events = NULL;
+        return 0;
+    }
+    song_schedule(song, sample_rate);
+    return 1;
+}
+
+// ---------------------------------------------------------------------
+// Event mapping
+
+typedef struct
+{
+    int channel; // -1 when unused
+    int note;
+    int held;      // key down
+    int sustained; // key up, waiting for the pedal
+    u64 started;
+    u64 released; // 0 for voices never played
+} VoiceSlot;
+
+typedef struct
+{
+    int bend; // -8192..8191
+    u8 volume;
+    u8 expression;
+    u8 brightness;
+    u8 resonance;
+    int sustain;
+    u8 velocity[128];
+} Channel;
+
+typedef struct
+{
+    Engine *engine;
+    u32 sample_rate;
+    int num_voices;
+    i32 headroom; // Q16.16, undoes the engine's divide by num_voices
+    FILE *out;
+    u64 frames;
+    VoiceSlot slots[MAX_VOICES];
+    Channel channels[16];
+    i16 block[BLOCK_SIZE];
+} Renderer;
+
+static void render_frames(Renderer *r, u64 frames)
+{
+    while (frames > 0)
+    {
+        int chunk = frames < BLOCK_SIZE ? (int)frames : BLOCK_SIZE;
+        engine_process_block(r->engine, r->block, chunk);
+        fwrite(r->block, sizeof(i16), (size_t)chunk, r->out);
+        r->frames += (u64)chunk;
+        frames -= (u64)chunk;
+    }
+}
+
+// Queue an engine event, rendering up to its time first if the queue is full
+static void push(Renderer *r, u64 time, EngineEventType type, int voice, u32 value)
+{
+    while (!engine_push_event(r->engine, time, type, voice, value))
+    {
+        u64 now = r->engine->sample_counter;
+        render_frames(r, time > now ? time - now : 1);
+    }
+}
+
+static u32 pitch_increment(Renderer *r, int note, int bend)
+{
+    double semitones = note - 69 + bend * 2.0 / 8192.0;
+    double freq = 440.0 * pow(2.0, semitones / 12.0);
+    // keep below Nyquist so the increment fits in a u32
+    double nyquist = r->sample_rate * 0.499;
+    if (freq > nyquist)
+        freq = nyquist;
+    return (u32)(freq * 4294967296.0 / r->sample_rate);
+}
+
+static u32 voice_gain(Renderer *r, const Channel *c, int velocity)
+{
+    double amp = (velocity / 127.0) * (c->volume / 127.0) * (c->expression / 127.0);
+    return (u32)(amp * r->headroom);
+}
+
+static u32 cutoff_hz(Renderer *r, const Channel *c)
+{
+    // 200 Hz .. 8 kHz, exponential, filter_set_cutoff clamps the top.
+    // Its 2 * sin(pi * f / sr) folds back above Nyquist, so stop there.
+    u32 hz = (u32)(200.0 * pow(40.0, c->brightness / 127.0));
+    if (hz > r->sample_rate / 2)
+        hz = r->sample_rate / 2;
+    return hz;
+}
+
+static u32 damping_q16(const Channel *c)
+{
+    // 0 -> 2.0 (flat), 64 -> ~1.0, 127 -> 0.25 (resonant)
+    double damping = 2.0 - 1.75 * c->resonance / 127.0;
+    return (u32)(damping * FIXED_ONE);
+}
+
+static void release_slot(Renderer *r, u64 time, int v)
+{
+    push(r, time, ENGINE_EVENT_NOTE_OFF, v, 0);
+    r->slots[v].held = 0;
+    r->slots[v].sustained = 0;
+    r->slots[v].released = time;
+}
+
+// Free voice that was released first, otherwise steal the oldest note
+static int allocate_voice(Renderer *r)
+{
+    int best = -1;
+    for (int v = 0; v < r->num_voices; v++)
+    {
+        const VoiceSlot *s = &r->slots[v];
+        if (s->held || s->sustained)
+            continue;
+        if (best < 0 || s->released < r->slots[best].released)
+            best = v;
+    }
+    if (best >= 0)
+        return best;
+
+    best = 0;
+    for (int v = 1; v < r->num_voices; v++)
+    {
+        if (r->slots[v].started < r->slots[best].started)
+            best = v;
+    }
+    return best;
+}
+
+static void note_on(Renderer *r, u64 time, int ch, int note, int velocity)
+{
+    Channel *c = &r->channels[ch];
+    int v = allocate_voice(r);
+    VoiceSlot *s = &r->slots[v];
+
+    s->channel = ch;
+    s->note = note;
+    s->held = 1;
+    s->sustained = 0;
+    s->started = time;
+    c->velocity[note] = (u8)velocity;
+
+    push(r, time, ENGINE_EVENT_GAIN, v, voice_gain(r, c, velocity));
+    push(r, time, ENGINE_EVENT_CUTOFF, v, cutoff_hz(r, c));
+    push(r, time, ENGINE_EVENT_DAMPING, v, damping_q16(c));
+    // integer Hz is too coarse for equal temperament, pitch follows right away
+    push(r, time, ENGINE_EVENT_NOTE_ON, v, 0);
+    push(r, time, ENGINE_EVENT_PITCH, v, pitch_increment(r, note, c->bend));
+}
+
+static void note_off(Renderer *r, u64 time, int ch, int note)
+{
+    for (int v = 0; v < r->num_voices; v++)
+    {
+        VoiceSlot *s = &r->slots[v];
+        if (!s->held || s->channel != ch || s->note != note)
+            continue;
+        if (r->channels[ch].sustain)
+        {
+            s->held = 0;
+            s->sustained = 1;
+        }
+        else
+        {
+            release_slot(r, time, v);
+        }
+    }
+}
+
+// Apply a channel parameter to every voice still sounding on it
+static void update_channel(Renderer *r, u64 time, int ch, EngineEventType type)
+{
+    Channel *c = &r->channels[ch];
+    for (int v = 0; v < r->num_voices; v++)
+    {
+        VoiceSlot *s = &r->slots[v];
+        if (s->channel != ch)
+            continue;
+        switch (type)
+        {
+        case ENGINE_EVENT_PITCH:
+            push(r, time, type, v, pitch_increment(r, s->note, c->bend));
+            break;
+        case ENGINE_EVENT_GAIN:
+            push(r, time, type, v, voice_gain(r, c, c->velocity[s->note]));
+            break;
+        case ENGINE_EVENT_CUTOFF:
+            push(r, time, type, v, cutoff_hz(r, c));
+            break;
+        case ENGINE_EVENT_DAMPING:
+            push(r, time, type, v, damping_q16(c));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void control_change(Renderer *r, u64 time, int ch, int cc, int value)
+{
+    Channel *c = &r->channels[ch];
+    switch (cc)
+    {
+    case 7:
+        c->volume = (u8)value;
+        update_channel(r, time, ch, ENGINE_EVENT_GAIN);
+        break;
+    case 11:
+        c->expression = (u8)value;
+        update_channel(r, time, ch, ENGINE_EVENT_GAIN);
+        break;
+    case 64:
+        c->sustain = value >= 64;
+        if (!c->sustain)
+        {
+            for (int v = 0; v < r->num_voices; v++)
+            {
+                if (r->slots[v].sustained && r->slots[v].channel == ch)
+                    release_slot(r, time, v);
+            }
+        }
+        break;
+    case 71:
+        c->resonance = (u8)value;
+        update_channel(r, time, ch, ENGINE_EVENT_DAMPING);
+        break;
+    case 74:
+        c->brightness = (u8)value;
+        update_channel(r, time, ch, ENGINE_EVENT_CUTOFF);
+        break;
+    case 120:
+    case 123:
+        for (int v = 0; v < r->num_voices; v++)
+        {
+            VoiceSlot *s = &r->slots[v];
+            if (s->channel == ch && (s->held || s->sustained))
+                release_slot(r, time, v);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void reset_channels(Renderer *r)
+{
+    for (int ch = 0; ch < 16; ch++)
+    {
+        Channel *c = &r->channels[ch];
+        memset(c, 0, sizeof(*c));
+        c->volume = 100;
+        c->expression = 127;
+        c->brightness = 100;
+        c->resonance = 56; // damping ~1.0, same as the other examples
+    }
+    for (int v = 0; v < MAX_VOICES; v++)
+    {
+        memset(&r->slots[v], 0, sizeof(VoiceSlot));
+        r->slots[v].channel = -1;
+    }
+}
+
+static int all_voices_idle(const Engine *e)
+{
+    for (int v = 0; v < e->config.num_voices; v++)
+    {
+        if (e->voices[v].env.state != ENV_IDLE)
+            return 0;
+    }
+    return 1;
+}
+
+// Render one song into an open WAV file, returns frames written
+static u64 render_song(Renderer *r, const MidiSong *song)
+{
+    engine_reset(r->engine);
+    reset_channels(r);
+    r->frames = 0;
+
+    for (int i = 0; i < song->count; i++)
+    {
+        const MidiEvent *ev = &song->events[i];
+        int ch = ev->status & 0x0F;
+        if (ev->status == META_TEMPO || ch == DRUM_CHANNEL)
+            continue;
+
+        // only keep events due within the next block in the queue
+        u64 now = r->engine->sample_counter;
+        if (ev->time > now + BLOCK_SIZE)
+            render_frames(r, (ev->time - now) / BLOCK_SIZE * BLOCK_SIZE);
+
+        switch (ev->status & 0xF0)
+        {
+        case 0x90:
+            if (ev->data2 > 0)
+                note_on(r, ev->time, ch, ev->data1, ev->data2);
+            else
+                note_off(r, ev->time, ch, ev->data1); // velocity 0 is a note off
+            break;
+        case 0x80:
+            note_off(r, ev->time, ch, ev->data1);
+            break;
+        case 0xB0:
+            control_change(r, ev->time, ch, ev->data1, ev->data2);
+            break;
+        case 0xE0:
+            r->channels[ch].bend = ((ev->data2 << 7) | ev->data1) - 8192;
+            update_channel(r, ev->time, ch, ENGINE_EVENT_PITCH);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // flush the queue, then let releases ring out
+    u64 last = song->count ? song->events[song->count - 1].time : 0;
+    if (last > r->engine->sample_counter)
+        render_frames(r, last - r->engine->sample_counter);
+    render_frames(r, BLOCK_SIZE);
+    u64 tail_end = r->frames + (u64)TAIL_MAX_SEC * r->sample_rate;
+    while (!all_voices_idle(r->engine) && r->frames < tail_end)
+        render_frames(r, BLOCK_SIZE);
+    render_frames(r, BLOCK_SIZE); // filter tail
+
+    return r->frames;
+}
+
+// ---------------------------------------------------------------------
+// Driver
+
+typedef struct
+{
+    char **inputs;
+    int num_inputs;
+    const char *output; // only with a single input
+    u32 sample_rate;
+    int num_voices;
+    int next; // next input, shared by workers
+    const i16 *wavetable;
+} Job;
+
+typedef struct
+{
+    Job *job;
+    double audio_sec;
+    int failed;
+} Worker;
+
+static double now_sec(void)
+{
+    return audio_now_ns() / 1e9;
+}
+
+static void output_path(const char *input, char *out, size_t size)
+{
+    const char *dot = strrchr(input, '.');
+    const char *slash = strrchr(input, '/');
+    size_t stem = (dot && (!slash || dot > slash)) ? (size_t)(dot - input) : strlen(input);
+    snprintf(out, size, "%.*s.wav", (int)stem, input);
+}
+
+static void *worker_run(void *arg)
+{
+    Worker *w = (Worker *)arg;
+    Job *job = w->job;
+
+    EngineConfig config = {
+        .sample_rate = job->sample_rate,
+        .num_voices = job->num_voices,
+        .block_size = BLOCK_SIZE,
+        .num_wavetables = 1,
+        .event_capacity = EVENT_CAPACITY,
+    };
+    size_t arena_size = engine_arena_size(&config);
+    void *arena = aligned_alloc(ENGINE_ALIGN, arena_size);
+    Renderer *r = calloc(1, sizeof(Renderer));
+    Engine *engine = arena ? engine_create(arena, arena_size, &config, job->wavetable) : NULL;
+    if (!engine || !r)
+    {
+        fprintf(stderr, "Out of memory\n");
+        free(arena);
+        free(r);
+        w->failed++;
+        return NULL;
+    }
+
+    for (int v = 0; v < config.num_voices; v++)
+    {
+        Voice *voice = engine_voice(engine, v);
+        env_init(&voice->env, env_ms_to_increment(5, config.sample_rate), env_ms_to_increment(400, config.sample_rate),
+                 env_sustain_to_hp(FIXED_ONE / 2), env_ms_to_increment(200, config.sample_rate));
+    }
+
+    r->engine = engine;
+    r->sample_rate = config.sample_rate;
+    r->num_voices = config.num_voices;
+    r->headroom = FIXED_ONE * config.num_voices / 4; // 4 loud notes reach full scale
+
+    for (;;)
+    {
+        int index = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (index >= job->num_inputs)
+            break;
+        const char *input = job->inputs[index];
+
+        char path[4096];
+        if (job->output)
+            snprintf(path, sizeof(path), "%s", job->output);
+        else
+            output_path(input, path, sizeof(path));
+
+        MidiSong song;
+        if (!song_load(&song, input, config.sample_rate))
+        {
+            fprintf(stderr, "%s: not a valid MIDI file\n", input);
+            w->failed++;
+            continue;
+        }
+        r->out = fopen(path, "wb");
+        if (!r->out)
+        {
+            perror(path);
+            free(song.events);
+            w->failed++;
+            continue;
+        }
+
+        double start = now_sec();
+        audio_wav_write_header(r->out, config.sample_rate, 0);
+        u64 frames = render_song(r, &song);
+        fseek(r->out, 0, SEEK_SET);
+        audio_wav_write_header(r->out, config.sample_rate, (u32)frames);
+        fclose(r->out);
+        double took = now_sec() - start;
+
+        double audio_sec = (double)frames / config.sample_rate;
+        w->audio_sec += audio_sec;
+        printf("%s -> %s: %.1f s audio in %.3f s (%.1fx realtime)\n", input, path, audio_sec, took,
+               took > 0 ? audio_sec / took : 0.0);
+        free(song.events);
+    }
+
+    free(r);
+    free(arena);
+    return NULL;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-o out.wav] [-r rate] [-v voices] [-j jobs] in.mid [more.mid ...]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    Job job = {0};
+    job.sample_rate = DEFAULT_SAMPLE_RATE;
+    job.num_voices = DEFAULT_VOICES;
+    int jobs = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "o:r:v:j:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'o':
+            job.output = optarg;
+            break;
+        case 'r':
+            job.sample_rate = (u32)atoi(optarg);
+            break;
+        case 'v':
+            job.num_voices = atoi(optarg);
+            break;
+        case 'j':
+            jobs = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    job.inputs = argv + optind;
+    job.num_inputs = argc - optind;
+    if (job.num_inputs == 0 || (job.output && job.num_inputs > 1) || job.sample_rate < 8000 ||
+        job.num_voices < 1 || job.num_voices > MAX_VOICES || jobs < 1 || jobs > MAX_JOBS)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (jobs > job.num_inputs)
+        jobs = job.num_inputs;
+
+    // Same saw-like table as the other examples
+    static i16 wavetable[WAVETABLE_SIZE] = {0};
+    static i32 harmonics[8] = {0};
+    static u32 phases[8] = {0};
+    for (int i = 0; i < 8; i++)
+    {
+        int n = i + 1;
+        harmonics[i] = FIXED_ONE / n;
+        phases[i] = (u32)(n * n) * 0x08000000u;
+    }
+    osc_build_wavetable(wavetable, harmonics, phases, 8);
+    job.wavetable = wavetable;
+
+    static Worker workers[MAX_JOBS];
+    static pthread_t threads[MAX_JOBS];
+    double start = now_sec();
+    int started = 1; // worker 0 runs on the main thread
+    for (int i = 0; i < jobs; i++)
+        workers[i].job = &job;
+    for (; started < jobs; started++)
+    {
+        if (pthread_create(&threads[started], NULL, worker_run, &workers[started]) != 0)
+        {
+            // remaining files are picked up by the workers already running
+            fprintf(stderr, "Could only start %d of %d jobs\n", started, jobs);
+            break;
+        }
+    }
+    worker_run(&workers[0]);
+    for (int i = 1; i < started; i++)
+        pthread_join(threads[i], NULL);
+    jobs = started;
+    double took = now_sec() - start;
+
+    double audio_sec = 0;
+    int failed = 0;
+    for (int i = 0; i < jobs; i++)
+    {
+        audio_sec += workers[i].audio_sec;
+        failed += workers[i].failed;
+    }
+    if (job.num_inputs > 1)
+    {
+        printf("%d files, %.1f s audio in %.3f s with %d jobs (%.1fx realtime)\n", job.num_inputs - failed,
+               audio_sec, took, jobs, took > 0 ? audio_sec / took : 0.0);
+    }
+    return failed ? 1 : 0;
+}
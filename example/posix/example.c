@@ -23,9 +23,25 @@ int main()
 
     osc_build_wavetable(wavetable, harmonics, phases, 8);
 
-    static Voice voices[3];
-    for (int v = 0; v < 3; v++)
-        voice_init(&voices[v], wavetable);
+#define NUM_VOICES 3
+#define BLOCK_SIZE 256
+
+    EngineConfig config = {
+        .sample_rate = SAMPLE_RATE,
+        .num_voices = NUM_VOICES,
+        .block_size = BLOCK_SIZE,
+        .num_wavetables = 1,
+        .event_capacity = 8,
+    };
+
+    // Whole synth state lives here, see engine_arena_size()
+    _Alignas(ENGINE_ALIGN) static u8 arena[4096];
+    Engine *engine = engine_create(arena, sizeof(arena), &config, wavetable);
+    if (!engine)
+    {
+        fprintf(stderr, "Arena too small: need %zu bytes\n", engine_arena_size(&config));
+        return 1;
+    }
 
     // Envelope
     i32 attack = env_ms_to_increment(2000, SAMPLE_RATE);
@@ -33,11 +49,12 @@ int main()
     i32 sustain = env_sustain_to_hp(FIXED_ONE / 3);
     i32 release = env_ms_to_increment(300, SAMPLE_RATE);
 
-    for (int v = 0; v < 3; v++)
+    for (int v = 0; v < NUM_VOICES; v++)
     {
-        env_init(&voices[v].env, attack, decay, sustain, release);
-        filter_init(&voices[v].filter, 5000, SAMPLE_RATE);
-        voices[v].filter.damping = FIXED_ONE;
+        Voice *voice = engine_voice(engine, v);
+        env_init(&voice->env, attack, decay, sustain, release);
+        filter_init(&voice->filter, 5000, SAMPLE_RATE);
+        voice->filter.damping = FIXED_ONE;
     }
 
     FILE *f = fopen("output.raw", "wb");
@@ -50,12 +67,13 @@ int main()
     int total_samples = SAMPLE_RATE * DURATION_SEC;
     int note_off_sample = SAMPLE_RATE * 3;
 
-    u32 freqs[3] = {220, 277, 329};
-    for (int v = 0; v < 3; v++)
-        voice_note_on(&voices[v], freqs[v], SAMPLE_RATE); // A3, C#4, E4
+    u32 freqs[NUM_VOICES] = {220, 277, 329}; // A3, C#4, E4
+    for (int v = 0; v < NUM_VOICES; v++)
+        engine_push_event(engine, 0, ENGINE_EVENT_NOTE_ON, v, freqs[v]);
+    for (int v = 0; v < NUM_VOICES; v++)
+        engine_push_event(engine, note_off_sample, ENGINE_EVENT_NOTE_OFF, v, 0);
 
-#define BLOCK_SIZE 256
-    static i32 mix_buffer[BLOCK_SIZE];
+    static i16 out[BLOCK_SIZE];
 
     for (int i = 0; i < total_samples; i += BLOCK_SIZE)
     {
@@ -63,48 +81,8 @@ int main()
         if (i + samples_to_process > total_samples)
             samples_to_process = total_samples - i;
 
-        // clear buffer
-        for (int k = 0; k < samples_to_process; k++)
-            mix_buffer[k] = 0;
-
-        if (i <= note_off_sample && note_off_sample < i + samples_to_process)
-        {
-            int first_part = note_off_sample - i;
-            if (first_part > 0)
-            {
-                for (int v = 0; v < 3; v++)
-                    voice_process_block(&voices[v], mix_buffer, first_part, v != 0);
-            }
-
-            for (int v = 0; v < 3; v++)
-                voice_note_off(&voices[v]);
-
-            int second_part = samples_to_process - first_part;
-            if (second_part > 0)
-            {
-                for (int v = 0; v < 3; v++)
-                    voice_process_block(&voices[v], mix_buffer + first_part, second_part, v != 0);
-            }
-        }
-        else
-        {
-            for (int v = 0; v < 3; v++)
-                voice_process_block(&voices[v], mix_buffer, samples_to_process, v != 0);
-        }
-
-        for (int k = 0; k < samples_to_process; k++)
-        {
-            i32 sample = mix_buffer[k] / 3; // normalize
-
-            // Clamp to i16
-            if (sample > 32767)
-                sample = 32767;
-            if (sample < -32768)
-                sample = -32768;
-
-            i16 out = (i16)sample;
-            fwrite(&out, sizeof(i16), 1, f);
-        }
+        engine_process_block(engine, out, samples_to_process);
+        fwrite(out, sizeof(i16), samples_to_process, f);
     }
 
     fclose(f);
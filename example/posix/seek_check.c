@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "mlws.h"
+
+// Checks the seek functions against plain rendering:
+//  - osc_seek / env_seek must land on exactly the same state
+//  - engine_seek output must match within SEEK_TOLERANCE once the
+//    SVF pre-roll is done. The fixed-point SVF settles on a small DC
+//    residue after silence that depends on its history, a seek cannot
+//    reproduce it, so that offset is checked against SEEK_DC_LIMIT
+//    separately.
+// Run with `make check`, exits non-zero on the first mismatch.
+
+#define SAMPLE_RATE 44100
+#define NUM_VOICES 3
+#define BLOCK_SIZE 256
+#define SEEK_TOLERANCE 2
+#define SEEK_DC_LIMIT 64 // ~-54 dBFS
+#define CHECK_BLOCKS 400
+
+static u32 rng_state = 1;
+
+static u32 rng(u32 range)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (rng_state >> 8) % range;
+}
+
+// Mix of regular rates and the edge cases: zero rates, full sustain
+static i32 random_rate(void)
+{
+    switch (rng(4))
+    {
+    case 0:
+        return 0;
+    case 1:
+        return ENV_FIXED_ONE;
+    default:
+        return 1 + (i32)rng(300000);
+    }
+}
+
+static int check_env(int trial)
+{
+    Env a, b;
+    i32 sustain = rng(3) == 0 ? ENV_FIXED_ONE : env_sustain_to_hp((i32)rng(FIXED_ONE));
+    env_init(&a, random_rate(), random_rate(), sustain, random_rate());
+
+    // seek through note on, note off and a retrigger mid-release
+    for (int stage = 0; stage < 3; stage++)
+    {
+        if (stage == 1)
+            env_note_off(&a);
+        else
+            env_note_on(&a);
+        b = a;
+
+        u32 n = rng(200000);
+        for (u32 i = 0; i < n; i++)
+            env_process(&a);
+        env_seek(&b, n);
+
+        if (a.state != b.state || a.curr_level != b.curr_level)
+        {
+            printf("env mismatch: trial %d stage %d after %u samples: state %d/%d level %d/%d\n", trial, stage, n,
+                   a.state, b.state, a.curr_level, b.curr_level);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int check_osc(int trial)
+{
+    Osc a, b;
+    static const i16 silence[WAVETABLE_SIZE] = {0};
+    osc_init(&a);
+    osc_set_frequency(&a, 1 + rng(20000), SAMPLE_RATE);
+    a.phase = rng(0xFFFFFF) << 8;
+    b = a;
+
+    u32 n = rng(500000);
+    for (u32 i = 0; i < n; i++)
+        osc_process(&a, silence);
+    osc_seek(&b, n);
+
+    if (a.phase != b.phase)
+    {
+        printf("osc mismatch: trial %d after %u samples\n", trial, n);
+        return 0;
+    }
+    return 1;
+}
+
+static Engine *make_engine(void *arena, size_t size, const i16 *wavetable)
+{
+    EngineConfig config = {
+        .sample_rate = SAMPLE_RATE,
+        .num_voices = NUM_VOICES,
+        .block_size = BLOCK_SIZE,
+        .num_wavetables = 1,
+        .event_capacity = 16,
+    };
+    Engine *e = engine_create(arena, size, &config, wavetable);
+    if (!e)
+        return NULL;
+
+    for (int v = 0; v < NUM_VOICES; v++)
+    {
+        Voice *voice = engine_voice(e, v);
+        env_init(&voice->env, env_ms_to_increment(200, SAMPLE_RATE), env_ms_to_increment(300, SAMPLE_RATE),
+                 env_sustain_to_hp(FIXED_ONE / 3), env_ms_to_increment(300, SAMPLE_RATE));
+        filter_init(&voice->filter, 800, SAMPLE_RATE);
+        voice->filter.damping = FIXED_ONE;
+    }
+
+    // staggered chord, the seek target lands between the events
+    u32 freqs[NUM_VOICES] = {220, 277, 329};
+    for (int v = 0; v < NUM_VOICES; v++)
+        engine_push_event(e, 1000 * v, ENGINE_EVENT_NOTE_ON, v, freqs[v]);
+    for (int v = 0; v < NUM_VOICES; v++)
+        engine_push_event(e, SAMPLE_RATE * 2 + 1000 * v, ENGINE_EVENT_NOTE_OFF, v, 0);
+    return e;
+}
+
+static int check_engine(u64 target)
+{
+    _Alignas(ENGINE_ALIGN) static u8 arena_a[8192];
+    _Alignas(ENGINE_ALIGN) static u8 arena_b[8192];
+    static i16 wavetable[WAVETABLE_SIZE];
+    static i16 out_a[BLOCK_SIZE];
+    static i16 out_b[BLOCK_SIZE];
+
+    i32 harmonics[4] = {FIXED_ONE, FIXED_ONE / 2, FIXED_ONE / 3, FIXED_ONE / 4};
+    osc_build_wavetable(wavetable, harmonics, NULL, 4);
+
+    Engine *rendered = make_engine(arena_a, sizeof(arena_a), wavetable);
+    Engine *seeked = make_engine(arena_b, sizeof(arena_b), wavetable);
+    if (!rendered || !seeked)
+    {
+        printf("engine arena too small\n");
+        return 0;
+    }
+
+    for (u64 done = 0; done < target;)
+    {
+        int chunk = target - done < BLOCK_SIZE ? (int)(target - done) : BLOCK_SIZE;
+        engine_process_block(rendered, out_a, chunk);
+        done += (u64)chunk;
+    }
+    engine_seek(seeked, target);
+
+    static int diff[CHECK_BLOCKS * BLOCK_SIZE];
+    long long sum = 0;
+    for (int b = 0; b < CHECK_BLOCKS; b++)
+    {
+        engine_process_block(rendered, out_a, BLOCK_SIZE);
+        engine_process_block(seeked, out_b, BLOCK_SIZE);
+        for (int i = 0; i < BLOCK_SIZE; i++)
+        {
+            diff[b * BLOCK_SIZE + i] = out_a[i] - out_b[i];
+            sum += out_a[i] - out_b[i];
+        }
+    }
+
+    int dc = (int)(sum / (CHECK_BLOCKS * BLOCK_SIZE));
+    int max_diff = 0;
+    for (int i = 0; i < CHECK_BLOCKS * BLOCK_SIZE; i++)
+    {
+        int d = abs(diff[i] - dc);
+        if (d > max_diff)
+            max_diff = d;
+    }
+
+    printf("engine_seek(%llu): max diff %d, dc offset %d\n", target, max_diff, dc);
+    return max_diff <= SEEK_TOLERANCE && abs(dc) <= SEEK_DC_LIMIT;
+}
+
+int main()
+{
+    for (int trial = 0; trial < 2000; trial++)
+    {
+        if (!check_env(trial) || !check_osc(trial))
+            return 1;
+    }
+    printf("env_seek / osc_seek: exact over 2000 trials\n");
+
+    // inside the first events, mid decay, mid release, long after
+    u64 targets[] = {100, 1500, SAMPLE_RATE, SAMPLE_RATE * 2 + 1500, SAMPLE_RATE * 10};
+    for (unsigned i = 0; i < sizeof(targets) / sizeof(targets[0]); i++)
+    {
+        if (!check_engine(targets[i]))
+            return 1;
+    }
+    return 0;
+}
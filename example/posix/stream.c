@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mlws_audio.h"
+
+// Realtime playback through mlws_audio.h sinks, prints latency and load
+// Usage: stream [null|file|alsa|sdl] [period] [buffers] [seconds] [voices]
+
+#define SAMPLE_RATE 48000
+#define MAX_VOICES 64
+#define LOOP_SEC 5
+
+typedef struct
+{
+    Engine *engine;
+    u64 next_loop;
+    u64 loop_length;
+    u64 note_off;
+} Player;
+
+// Re-queue the chord once the previous loop has drained, then render
+static void player_render(void *user, i16 *out, int frames)
+{
+    Player *p = (Player *)user;
+    Engine *e = p->engine;
+    static const u32 freqs[3] = {220, 277, 329}; // A3, C#4, E4
+
+    if (e->event_head == e->event_tail)
+    {
+        for (int v = 0; v < e->config.num_voices; v++)
+            engine_push_event(e, p->next_loop, ENGINE_EVENT_NOTE_ON, v, freqs[v % 3] << (v / 3 % 3)); // extra voices go up octaves
+        for (int v = 0; v < e->config.num_voices; v++)
+            engine_push_event(e, p->next_loop + p->note_off, ENGINE_EVENT_NOTE_OFF, v, 0);
+        p->next_loop += p->loop_length;
+    }
+
+    engine_process_block(e, out, frames);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *sink_name = argc > 1 ? argv[1] : "null";
+    int period = argc > 2 ? atoi(argv[2]) : 128;
+    int buffers = argc > 3 ? atoi(argv[3]) : 2;
+    int seconds = argc > 4 ? atoi(argv[4]) : 5;
+    int voices = argc > 5 ? atoi(argv[5]) : 3;
+    if (voices < 1 || voices > MAX_VOICES)
+    {
+        fprintf(stderr, "voices must be 1..%d\n", MAX_VOICES);
+        return 1;
+    }
+
+    static i16 wavetable[WAVETABLE_SIZE] = {0};
+    static i32 harmonics[8] = {0};
+    static u32 phases[8] = {0};
+    for (int i = 0; i < 8; i++)
+    {
+        int n = i + 1;
+        harmonics[i] = FIXED_ONE / n;
+        phases[i] = (u32)(n * n) * 0x08000000u;
+    }
+    osc_build_wavetable(wavetable, harmonics, phases, 8);
+
+    EngineConfig config = {
+        .sample_rate = SAMPLE_RATE,
+        .num_voices = voices,
+        .block_size = 256,
+        .num_wavetables = 1,
+        .event_capacity = 2 * MAX_VOICES,
+    };
+    _Alignas(ENGINE_ALIGN) static u8 arena[16384];
+    Engine *engine = engine_create(arena, sizeof(arena), &config, wavetable);
+    if (!engine)
+    {
+        fprintf(stderr, "Arena too small: need %zu bytes\n", engine_arena_size(&config));
+        return 1;
+    }
+
+    for (int v = 0; v < voices; v++)
+    {
+        Voice *voice = engine_voice(engine, v);
+        env_init(&voice->env, env_ms_to_increment(500, SAMPLE_RATE), env_ms_to_increment(1000, SAMPLE_RATE),
+                 env_sustain_to_hp(FIXED_ONE / 3), env_ms_to_increment(300, SAMPLE_RATE));
+        filter_init(&voice->filter, 2000, SAMPLE_RATE);
+        voice->filter.damping = FIXED_ONE;
+    }
+
+    Player player = {engine, 0, (u64)SAMPLE_RATE * LOOP_SEC, (u64)SAMPLE_RATE * 3};
+
+    static AudioStream stream;
+    if (!audio_stream_init(&stream, SAMPLE_RATE, period, buffers, player_render, &player))
+    {
+        fprintf(stderr, "Invalid stream: period 1..%d, buffers 2..%d\n", AUDIO_MAX_PERIOD, AUDIO_MAX_BUFFERS);
+        return 1;
+    }
+
+    static AudioSink sink;
+    if (strcmp(sink_name, "null") == 0)
+    {
+        audio_sink_null(&sink, &stream);
+    }
+    else if (strcmp(sink_name, "file") == 0)
+    {
+        if (!audio_sink_file(&sink, &stream, "stream.wav"))
+        {
+            perror("Failed to open stream.wav");
+            return 1;
+        }
+    }
+#ifdef MLWS_AUDIO_ALSA
+    else if (strcmp(sink_name, "alsa") == 0)
+    {
+        audio_sink_alsa(&sink, &stream, "default");
+    }
+#endif
+#ifdef MLWS_AUDIO_SDL
+    else if (strcmp(sink_name, "sdl") == 0)
+    {
+        if (SDL_Init(SDL_INIT_AUDIO) < 0)
+        {
+            fprintf(stderr, "SDL init failed: %s\n", SDL_GetError());
+            return 1;
+        }
+        audio_sink_sdl(&sink, &stream);
+    }
+#endif
+    else
+    {
+        fprintf(stderr, "Unknown or disabled sink: %s\n", sink_name);
+        return 1;
+    }
+
+    if (!audio_sink_start(&sink))
+    {
+        fprintf(stderr, "Failed to start %s sink\n", sink.name);
+        return 1;
+    }
+    audio_sleep_ns((u64)seconds * 1000000000ull);
+    audio_sink_stop(&sink);
+
+#ifdef MLWS_AUDIO_SDL
+    if (strcmp(sink_name, "sdl") == 0)
+        SDL_Quit();
+#endif
+
+    const AudioStats *st = &stream.stats;
+    double period_us = audio_period_ns(&stream) / 1000.0;
+    double render_avg_us = st->periods_rendered ? st->render_ns_total / 1000.0 / st->periods_rendered : 0;
+    double latency_avg_us = st->periods_consumed ? st->latency_ns_total / 1000.0 / st->periods_consumed : 0;
+
+    printf("sink %s, %d voices, period %d x %d buffers (%.2f ms ring)\n", sink.name, voices, period, buffers,
+           period_us * buffers / 1000.0);
+    printf("periods rendered %llu, consumed %llu, underruns %llu, clock slips %llu\n", st->periods_rendered,
+           st->periods_consumed, st->underruns, st->clock_slips);
+    printf("render avg %.1f us, max %.1f us (load %.1f%% avg, %.1f%% peak)\n", render_avg_us,
+           st->render_ns_max / 1000.0, 100.0 * render_avg_us / period_us, 100.0 * st->render_ns_max / 1000.0 / period_us);
+    printf("ring latency avg %.2f ms, max %.2f ms (ring only)\n", latency_avg_us / 1000.0,
+           st->latency_ns_max / 1000000.0);
+    if (st->output_latency_count)
+    {
+        printf("output latency avg %.2f ms, max %.2f ms (ring + device buffer)\n",
+               st->output_latency_ns_total / 1000000.0 / st->output_latency_count,
+               st->output_latency_ns_max / 1000000.0);
+    }
+    if (sink.failed)
+    {
+        fprintf(stderr, "%s sink stopped early, device failed\n", sink.name);
+        return 1;
+    }
+    return 0;
+}
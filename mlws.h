@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stddef.h>
+
 // Common definitions
 typedef unsigned long long u64;
 typedef signed long long i64;
@@ -188,6 +190,12 @@ static inline i16 osc_process(Osc *osc, const i16 *wavetable)
     return p1 + delta;
 }
 
+// Same as n calls to osc_process, phase wraps exactly like the u32 adds
+static inline void osc_seek(Osc *osc, u64 n)
+{
+    osc->phase += (u32)(osc->increment * n);
+}
+
 // Envelope states
 typedef enum
 {
@@ -304,6 +312,80 @@ static inline i32 env_process(Env *env)
     return fixed_mul(linear, linear);
 }
 
+// Samples a segment needs to cover distance at rate, env_process always
+// spends at least one sample before switching state.
+// Returns 0 if the segment never ends (zero rate, target not reached).
+static inline u64 env_segment_steps(i64 distance, i32 rate)
+{
+    if (distance <= 0)
+        return 1;
+    if (rate == 0)
+        return 0;
+    return (u64)((distance + rate - 1) / rate);
+}
+
+// Closed form of n calls to env_process: every segment is linear in
+// curr_level, so each one is crossed in O(1)
+static inline void env_seek(Env *env, u64 n)
+{
+    while (n > 0)
+    {
+        i32 rate;
+        i64 distance;
+        switch (env->state)
+        {
+        case ENV_IDLE:
+            env->curr_level = 0;
+            return;
+        case ENV_SUSTAIN:
+            env->curr_level = env->sustain_level;
+            return;
+        case ENV_ATTACK:
+            rate = env->attack;
+            distance = (i64)ENV_FIXED_ONE - env->curr_level;
+            break;
+        case ENV_DECAY:
+            rate = -env->decay;
+            distance = (i64)env->curr_level - env->sustain_level;
+            break;
+        case ENV_RELEASE:
+        default:
+            rate = -env->release;
+            distance = env->curr_level;
+            break;
+        }
+
+        u64 steps = env_segment_steps(distance, rate < 0 ? -rate : rate);
+        if (steps == 0)
+        {
+            return; // segment never ends
+        }
+        if (n < steps)
+        {
+            env->curr_level += (i32)((i64)rate * (i64)n);
+            return;
+        }
+
+        // segment ends inside the jump, land on its target
+        n -= steps;
+        switch (env->state)
+        {
+        case ENV_ATTACK:
+            env->curr_level = ENV_FIXED_ONE;
+            env->state = ENV_DECAY;
+            break;
+        case ENV_DECAY:
+            env->curr_level = env->sustain_level;
+            env->state = ENV_SUSTAIN;
+            break;
+        default:
+            env->curr_level = 0;
+            env->state = ENV_IDLE;
+            break;
+        }
+    }
+}
+
 // SVF filter impl
 typedef struct
 {
@@ -314,11 +396,9 @@ typedef struct
     i32 damping; // inverse proportional w/ q
 } Filter;
 
-static inline void filter_init(Filter *filter, int cutoff_freq, int sr)
+// Update cutoff without touching filter state
+static inline void filter_set_cutoff(Filter *filter, int cutoff_freq, int sr)
 {
-    filter->low = 0;
-    filter->band = 0;
-
     // calculate cutoff
     // F = 2*sin(PI * freq / sr)
     u32 phase = (u32)(((u64)cutoff_freq << 31) / sr); // phase = freq * 2^31 / sr
@@ -332,6 +412,13 @@ static inline void filter_init(Filter *filter, int cutoff_freq, int sr)
     }
 }
 
+static inline void filter_init(Filter *filter, int cutoff_freq, int sr)
+{
+    filter->low = 0;
+    filter->band = 0;
+    filter_set_cutoff(filter, cutoff_freq, sr);
+}
+
 // Chamberlin SVF impl
 static inline i32 filter_process(Filter *f, i32 input)
 {
@@ -352,6 +439,7 @@ typedef struct
     Env env;
     Filter filter;
     const i16 *wavetable;
+    i32 gain; // Q16.16 envelope scale, e.g. velocity
 } Voice;
 
 static inline void voice_init(Voice *v, const i16 *wavetable)
@@ -363,6 +451,7 @@ static inline void voice_init(Voice *v, const i16 *wavetable)
     v->filter.cutoff = 52429;  // ~0.8 in Q16.16, 5.6k @ 44.1kHz
     v->filter.damping = 32768; // Q16.16 = 0.5
     v->wavetable = wavetable;
+    v->gain = FIXED_ONE;
 }
 
 static inline void voice_note_on(Voice *v, u32 freq, u32 sample_rate)
@@ -379,7 +468,7 @@ static inline void voice_note_off(Voice *v)
 static inline i32 voice_process(Voice *v)
 {
     i32 osc_out = osc_process(&v->osc, v->wavetable);
-    i32 env_amp = env_process(&v->env);
+    i32 env_amp = fixed_mul(env_process(&v->env), v->gain);
     i32 signal = fixed_mul(osc_out, env_amp);
     return filter_process(&v->filter, signal);
 }
@@ -395,3 +484,337 @@ static inline void voice_process_block(Voice *v, i32 *out, int num_samples, int
             out[i] = sample;
     }
 }
+
+// Samples rendered at the end of a seek to settle the filter
+#define VOICE_SEEK_PREROLL 256
+
+// Filter state has no closed form, drop it and let it settle.
+// Note the fixed-point SVF decays to a small history dependent DC
+// residue rather than 0 after silence, a seek lands on 0 instead.
+static inline void voice_seek_analytic(Voice *v, u64 n)
+{
+    osc_seek(&v->osc, n);
+    env_seek(&v->env, n);
+    v->filter.low = 0;
+    v->filter.band = 0;
+}
+
+// Advance the voice n samples without rendering them.
+// Osc and env jump in O(1), the last VOICE_SEEK_PREROLL samples are
+// rendered to warm up the SVF state.
+static inline void voice_seek(Voice *v, u64 n)
+{
+    u64 preroll = n < VOICE_SEEK_PREROLL ? n : VOICE_SEEK_PREROLL;
+    if (n > preroll)
+        voice_seek_analytic(v, n - preroll);
+    for (u64 i = 0; i < preroll; i++)
+        voice_process(v);
+}
+
+// -----------------------------------------------------------------
+
+// Engine = voices, scratch buffer, wavetable refs and event queue
+// packed into one caller-provided arena. No heap, no globals, so
+// every instance is isolated and can be driven from its own thread.
+
+#define ENGINE_ALIGN 64 // cache line
+
+typedef enum
+{
+    ENGINE_EVENT_NOTE_ON = 0, // value = frequency in Hz
+    ENGINE_EVENT_NOTE_OFF,
+    ENGINE_EVENT_WAVETABLE, // value = wavetable slot
+    ENGINE_EVENT_PITCH,     // value = osc phase increment, no retrigger
+    ENGINE_EVENT_GAIN,      // value = Voice.gain in Q16.16
+    ENGINE_EVENT_CUTOFF,    // value = filter cutoff in Hz
+    ENGINE_EVENT_DAMPING,   // value = filter damping in Q16.16
+} EngineEventType;
+
+typedef struct
+{
+    u64 time; // absolute sample time
+    u32 value;
+    u16 voice;
+    u16 type;
+} EngineEvent;
+
+typedef struct
+{
+    u32 sample_rate;
+    int num_voices;
+    int block_size;     // scratch buffer length in samples
+    int num_wavetables; // wavetable reference slots
+    int event_capacity; // must be a power of two
+} EngineConfig;
+
+typedef struct
+{
+    EngineConfig config;
+    u64 sample_counter;
+
+    Voice *voices;
+    i32 *mix_buffer;
+    const i16 **wavetables;
+
+    // Single-producer ring, events are expected in time order
+    EngineEvent *events;
+    u32 event_mask;
+    u32 event_head;
+    u32 event_tail;
+} Engine;
+
+static inline size_t engine_align_up(size_t size)
+{
+    return (size + ENGINE_ALIGN - 1) & ~(size_t)(ENGINE_ALIGN - 1);
+}
+
+// Bytes needed for an engine with this config, rounded up to a whole
+// number of cache lines so arenas can be packed back to back.
+// Returns 0 for an invalid config.
+static inline size_t engine_arena_size(const EngineConfig *config)
+{
+    if (config->sample_rate == 0 || config->num_voices <= 0 || config->block_size <= 0 ||
+        config->num_wavetables <= 0 || config->event_capacity <= 0 ||
+        (config->event_capacity & (config->event_capacity - 1)) != 0)
+    {
+        return 0;
+    }
+
+    size_t size = engine_align_up(sizeof(Engine));
+    size += engine_align_up(sizeof(Voice) * (size_t)config->num_voices);
+    size += engine_align_up(sizeof(i32) * (size_t)config->block_size);
+    size += engine_align_up(sizeof(const i16 *) * (size_t)config->num_wavetables);
+    size += engine_align_up(sizeof(EngineEvent) * (size_t)config->event_capacity);
+    return size;
+}
+
+// Rewind the engine to silence without touching voice parameters
+// (envelope rates, filter coefficients, wavetable binding).
+static inline void engine_reset(Engine *e)
+{
+    for (int v = 0; v < e->config.num_voices; v++)
+    {
+        Voice *voice = &e->voices[v];
+        voice->osc.phase = 0;
+        voice->env.state = ENV_IDLE;
+        voice->env.curr_level = 0;
+        voice->filter.low = 0;
+        voice->filter.band = 0;
+    }
+    e->event_head = 0;
+    e->event_tail = 0;
+    e->sample_counter = 0;
+}
+
+// Lay out an engine inside arena. arena must be ENGINE_ALIGN aligned
+// and at least engine_arena_size(config) bytes long.
+// All voices start bound to wavetable (slot 0), which must not be NULL.
+static inline Engine *engine_create(void *arena, size_t arena_size, const EngineConfig *config, const i16 *wavetable)
+{
+    size_t needed = engine_arena_size(config);
+    if (!arena || !wavetable || needed == 0 || arena_size < needed || ((size_t)arena & (ENGINE_ALIGN - 1)) != 0)
+    {
+        return NULL;
+    }
+
+    u8 *base = (u8 *)arena;
+    size_t offset = 0;
+
+    Engine *e = (Engine *)(base + offset);
+    offset += engine_align_up(sizeof(Engine));
+    e->voices = (Voice *)(base + offset);
+    offset += engine_align_up(sizeof(Voice) * (size_t)config->num_voices);
+    e->mix_buffer = (i32 *)(base + offset);
+    offset += engine_align_up(sizeof(i32) * (size_t)config->block_size);
+    e->wavetables = (const i16 **)(base + offset);
+    offset += engine_align_up(sizeof(const i16 *) * (size_t)config->num_wavetables);
+    e->events = (EngineEvent *)(base + offset);
+
+    e->config = *config;
+    e->event_mask = (u32)config->event_capacity - 1;
+
+    for (int i = 0; i < config->num_wavetables; i++)
+        e->wavetables[i] = NULL;
+    e->wavetables[0] = wavetable;
+
+    for (int v = 0; v < config->num_voices; v++)
+        voice_init(&e->voices[v], wavetable);
+
+    engine_reset(e);
+    return e;
+}
+
+static inline Voice *engine_voice(Engine *e, int index)
+{
+    return &e->voices[index];
+}
+
+// Voices bound to the slot's previous table follow it to the new one.
+// Returns 0 for an out of range slot, or NULL for slot 0.
+static inline int engine_set_wavetable(Engine *e, int slot, const i16 *wavetable)
+{
+    if (slot < 0 || slot >= e->config.num_wavetables || (slot == 0 && !wavetable))
+    {
+        return 0;
+    }
+    const i16 *old = e->wavetables[slot];
+    if (old && wavetable)
+    {
+        for (int v = 0; v < e->config.num_voices; v++)
+        {
+            if (e->voices[v].wavetable == old)
+                e->voices[v].wavetable = wavetable;
+        }
+    }
+    e->wavetables[slot] = wavetable;
+    return 1;
+}
+
+// Queue an event at absolute sample time. Returns 0 if the queue is full.
+static inline int engine_push_event(Engine *e, u64 time, EngineEventType type, int voice, u32 value)
+{
+    if (e->event_tail - e->event_head > e->event_mask)
+    {
+        return 0;
+    }
+    EngineEvent *ev = &e->events[e->event_tail & e->event_mask];
+    ev->time = time;
+    ev->value = value;
+    ev->voice = (u16)voice;
+    ev->type = (u16)type;
+    e->event_tail++;
+    return 1;
+}
+
+static inline void engine_apply_event(Engine *e, const EngineEvent *ev)
+{
+    if (ev->voice >= e->config.num_voices)
+    {
+        return;
+    }
+    Voice *v = &e->voices[ev->voice];
+    switch ((EngineEventType)ev->type)
+    {
+    case ENGINE_EVENT_NOTE_ON:
+        voice_note_on(v, ev->value, e->config.sample_rate);
+        break;
+    case ENGINE_EVENT_NOTE_OFF:
+        voice_note_off(v);
+        break;
+    case ENGINE_EVENT_WAVETABLE:
+        // unset slots are ignored, the voice keeps its table
+        if (ev->value < (u32)e->config.num_wavetables && e->wavetables[ev->value])
+            v->wavetable = e->wavetables[ev->value];
+        break;
+    case ENGINE_EVENT_PITCH:
+        v->osc.increment = ev->value;
+        break;
+    case ENGINE_EVENT_GAIN:
+        v->gain = (i32)ev->value;
+        break;
+    case ENGINE_EVENT_CUTOFF:
+        filter_set_cutoff(&v->filter, (int)ev->value, (int)e->config.sample_rate);
+        break;
+    case ENGINE_EVENT_DAMPING:
+        v->filter.damping = (i32)ev->value;
+        break;
+    }
+}
+
+// Render up to block_size samples into the scratch buffer
+static inline void engine_mix(Engine *e, int num_samples)
+{
+    int offset = 0;
+    while (offset < num_samples)
+    {
+        int run = num_samples - offset;
+        // split the block at the next due event
+        while (e->event_head != e->event_tail)
+        {
+            const EngineEvent *ev = &e->events[e->event_head & e->event_mask];
+            if (ev->time > e->sample_counter)
+            {
+                u64 until = ev->time - e->sample_counter;
+                if (until < (u64)run)
+                    run = (int)until;
+                break;
+            }
+            engine_apply_event(e, ev);
+            e->event_head++;
+        }
+
+        for (int v = 0; v < e->config.num_voices; v++)
+            voice_process_block(&e->voices[v], e->mix_buffer + offset, run, v != 0);
+
+        offset += run;
+        e->sample_counter += run;
+    }
+}
+
+// Advance the engine n samples without rendering them. Queued events
+// due before the target are applied at their exact time. Cost does not
+// depend on n beyond one VOICE_SEEK_PREROLL of rendering at the end.
+static inline void engine_seek(Engine *e, u64 n)
+{
+    u64 preroll = n < VOICE_SEEK_PREROLL ? n : VOICE_SEEK_PREROLL;
+    u64 preroll_start = e->sample_counter + (n - preroll);
+
+    while (e->sample_counter < preroll_start)
+    {
+        u64 run = preroll_start - e->sample_counter;
+        if (e->event_head != e->event_tail)
+        {
+            const EngineEvent *ev = &e->events[e->event_head & e->event_mask];
+            if (ev->time <= e->sample_counter)
+            {
+                engine_apply_event(e, ev);
+                e->event_head++;
+                continue;
+            }
+            if (ev->time - e->sample_counter < run)
+                run = ev->time - e->sample_counter;
+        }
+
+        for (int v = 0; v < e->config.num_voices; v++)
+            voice_seek_analytic(&e->voices[v], run);
+        e->sample_counter += run;
+    }
+
+    while (preroll > 0)
+    {
+        int chunk = e->config.block_size;
+        if ((u64)chunk > preroll)
+            chunk = (int)preroll;
+        engine_mix(e, chunk);
+        preroll -= chunk;
+    }
+}
+
+// Render num_samples of normalized, clamped mono output
+static inline void engine_process_block(Engine *e, i16 *out, int num_samples)
+{
+    while (num_samples > 0)
+    {
+        int chunk = num_samples;
+        if (chunk > e->config.block_size)
+            chunk = e->config.block_size;
+
+        engine_mix(e, chunk);
+
+        for (int k = 0; k < chunk; k++)
+        {
+            i32 sample = e->mix_buffer[k] / e->config.num_voices; // normalize
+
+            // Clamp to i16
+            if (sample > 32767)
+                sample = 32767;
+            if (sample < -32768)
+                sample = -32768;
+
+            out[k] = (i16)sample;
+        }
+
+        out += chunk;
+        num_samples -= chunk;
+    }
+}
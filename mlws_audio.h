@@ -0,0 +1,547 @@
+#pragma once
+
+// Realtime audio backends for mlws
+//
+// A render thread fills a lock-free ring of periods ahead of the device,
+// the device side (callback or writer thread) only copies out of it.
+// Sinks:
+//  - null: clock driven, consumes one period per period time (load tests)
+//  - file: null sink that also records what it consumed to a WAV file
+//  - ALSA: define MLWS_AUDIO_ALSA and link -lasound
+//  - SDL2: define MLWS_AUDIO_SDL and link SDL2
+//
+// Single producer (render thread) / single consumer (sink) only.
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "mlws.h"
+
+#ifdef MLWS_AUDIO_ALSA
+#include <alsa/asoundlib.h>
+#endif
+#ifdef MLWS_AUDIO_SDL
+#include <SDL2/SDL.h>
+#endif
+
+#define AUDIO_MAX_PERIOD 4096
+#define AUDIO_MAX_BUFFERS 3
+
+// Fill out with frames of mono samples, called on the render thread
+typedef void (*AudioRenderFn)(void *user, i16 *out, int frames);
+
+typedef struct
+{
+    // render thread side
+    u64 periods_rendered;
+    u64 render_ns_total;
+    u64 render_ns_max;
+
+    // device side
+    u64 periods_consumed;
+    u64 underruns;
+    u64 latency_ns_total; // ring only: time from render done to first copy
+    u64 latency_ns_max;
+    u64 latency_ns_last;
+    u64 clock_slips; // clock sinks woke up a period or more late
+
+    // ring + device buffer, only sinks that can query the device (ALSA)
+    u64 output_latency_count;
+    u64 output_latency_ns_total;
+    u64 output_latency_ns_max;
+} AudioStats;
+
+typedef struct
+{
+    AudioRenderFn render;
+    void *user;
+    u32 sample_rate;
+    int period;
+    int num_buffers;
+
+    i16 buffers[AUDIO_MAX_BUFFERS][AUDIO_MAX_PERIOD];
+    u64 rendered_at[AUDIO_MAX_BUFFERS];
+
+    // Free running period counters, slot = pos % num_buffers
+    u32 write_pos; // written by render thread only
+    u32 read_pos;  // written by device side only
+    int read_offset;
+
+    int running;
+    pthread_t thread;
+    sem_t wake; // posted by the device side when it frees a slot
+    AudioStats stats;
+} AudioStream;
+
+static inline u64 audio_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+}
+
+static inline void audio_sleep_ns(u64 ns)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ull);
+    ts.tv_nsec = (long)(ns % 1000000000ull);
+    nanosleep(&ts, NULL);
+}
+
+static inline u64 audio_period_ns(const AudioStream *s)
+{
+    return (u64)s->period * 1000000000ull / s->sample_rate;
+}
+
+// Adapter to render straight from an Engine
+static inline void audio_render_engine(void *user, i16 *out, int frames)
+{
+    engine_process_block((Engine *)user, out, frames);
+}
+
+// Returns 0 on invalid parameters
+static inline int audio_stream_init(AudioStream *s, u32 sample_rate, int period, int num_buffers,
+                                    AudioRenderFn render, void *user)
+{
+    if (sample_rate == 0 || period <= 0 || period > AUDIO_MAX_PERIOD ||
+        num_buffers < 2 || num_buffers > AUDIO_MAX_BUFFERS || !render)
+    {
+        return 0;
+    }
+    memset(s, 0, sizeof(*s));
+    s->render = render;
+    s->user = user;
+    s->sample_rate = sample_rate;
+    s->period = period;
+    s->num_buffers = num_buffers;
+    return 1;
+}
+
+static inline void audio_stream_render_period(AudioStream *s)
+{
+    u32 w = s->write_pos;
+    int slot = (int)(w % (u32)s->num_buffers);
+
+    u64 start = audio_now_ns();
+    s->render(s->user, s->buffers[slot], s->period);
+    u64 done = audio_now_ns();
+
+    u64 took = done - start;
+    s->stats.periods_rendered++;
+    s->stats.render_ns_total += took;
+    if (took > s->stats.render_ns_max)
+        s->stats.render_ns_max = took;
+    s->rendered_at[slot] = done;
+
+    // publish the slot to the device side
+    __atomic_store_n(&s->write_pos, w + 1, __ATOMIC_RELEASE);
+}
+
+static inline void *audio_stream_thread(void *arg)
+{
+    AudioStream *s = (AudioStream *)arg;
+
+#ifdef __linux__
+    // best effort, needs rtprio permission
+    struct sched_param param;
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+
+    while (__atomic_load_n(&s->running, __ATOMIC_ACQUIRE))
+    {
+        u32 r = __atomic_load_n(&s->read_pos, __ATOMIC_ACQUIRE);
+        if (s->write_pos - r >= (u32)s->num_buffers)
+        {
+            // ring is full, sleep until the device frees a slot
+            sem_wait(&s->wake);
+            continue;
+        }
+        audio_stream_render_period(s);
+    }
+    return NULL;
+}
+
+// Pre-render the whole ring, then keep it topped up from a render thread
+static inline int audio_stream_start(AudioStream *s)
+{
+    while (s->write_pos - s->read_pos < (u32)s->num_buffers)
+        audio_stream_render_period(s);
+
+    if (sem_init(&s->wake, 0, 0) != 0)
+        return 0;
+    __atomic_store_n(&s->running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&s->thread, NULL, audio_stream_thread, s) != 0)
+    {
+        s->running = 0;
+        sem_destroy(&s->wake);
+        return 0;
+    }
+    return 1;
+}
+
+static inline void audio_stream_stop(AudioStream *s)
+{
+    if (!__atomic_load_n(&s->running, __ATOMIC_ACQUIRE))
+        return;
+    __atomic_store_n(&s->running, 0, __ATOMIC_RELEASE);
+    sem_post(&s->wake);
+    pthread_join(s->thread, NULL);
+    sem_destroy(&s->wake);
+}
+
+// Device side: copy frames out of the ring. Never renders or blocks
+// (sem_post does not block), missing data is replaced with silence and
+// counted as an underrun.
+static inline void audio_stream_read(AudioStream *s, i16 *out, int frames)
+{
+    while (frames > 0)
+    {
+        u32 r = s->read_pos;
+        if (r == __atomic_load_n(&s->write_pos, __ATOMIC_ACQUIRE))
+        {
+            memset(out, 0, sizeof(i16) * (size_t)frames);
+            s->stats.underruns++;
+            return;
+        }
+
+        int slot = (int)(r % (u32)s->num_buffers);
+        if (s->read_offset == 0)
+        {
+            u64 age = audio_now_ns() - s->rendered_at[slot];
+            s->stats.latency_ns_last = age;
+            s->stats.latency_ns_total += age;
+            if (age > s->stats.latency_ns_max)
+                s->stats.latency_ns_max = age;
+        }
+
+        int copy = s->period - s->read_offset;
+        if (copy > frames)
+            copy = frames;
+        memcpy(out, s->buffers[slot] + s->read_offset, sizeof(i16) * (size_t)copy);
+        out += copy;
+        frames -= copy;
+
+        s->read_offset += copy;
+        if (s->read_offset == s->period)
+        {
+            // hand the slot back to the render thread
+            s->read_offset = 0;
+            s->stats.periods_consumed++;
+            __atomic_store_n(&s->read_pos, r + 1, __ATOMIC_RELEASE);
+            sem_post(&s->wake);
+        }
+    }
+}
+
+static inline void audio_put_le(u8 *p, u32 value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        p[i] = (u8)(value >> (8 * i));
+}
+
+// 16-bit mono PCM header, write it again with the final frame count
+// once done to patch the sizes. Samples are expected little endian.
+static inline void audio_wav_write_header(FILE *f, u32 sample_rate, u32 frames)
+{
+    u32 data_size = frames * (u32)sizeof(i16);
+    u8 h[44];
+    memcpy(h, "RIFF", 4);
+    audio_put_le(h + 4, 36 + data_size, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    audio_put_le(h + 16, 16, 4); // fmt chunk size
+    audio_put_le(h + 20, 1, 2);  // PCM
+    audio_put_le(h + 22, 1, 2);  // mono
+    audio_put_le(h + 24, sample_rate, 4);
+    audio_put_le(h + 28, sample_rate * (u32)sizeof(i16), 4); // byte rate
+    audio_put_le(h + 32, sizeof(i16), 2);                    // block align
+    audio_put_le(h + 34, 16, 2);                             // bits per sample
+    memcpy(h + 36, "data", 4);
+    audio_put_le(h + 40, data_size, 4);
+    fwrite(h, 1, sizeof(h), f);
+}
+
+// -----------------------------------------------------------------
+
+// Sink = the device side of a stream
+typedef struct AudioSink AudioSink;
+
+struct AudioSink
+{
+    const char *name;
+    AudioStream *stream;
+    int (*open)(AudioSink *sink);
+    void (*close)(AudioSink *sink);
+
+    // device side thread (clock driven sinks, ALSA)
+    pthread_t thread;
+    int thread_started;
+    int running;
+    int failed; // the device went away, the sink stopped itself
+    FILE *file;
+    u64 frames_written;
+    i16 scratch[AUDIO_MAX_PERIOD];
+
+#ifdef MLWS_AUDIO_ALSA
+    const char *alsa_device;
+    snd_pcm_t *pcm;
+#endif
+#ifdef MLWS_AUDIO_SDL
+    SDL_AudioDeviceID sdl_device;
+#endif
+};
+
+// Start the stream (pre-fill + render thread), then the device
+static inline int audio_sink_start(AudioSink *sink)
+{
+    if (!audio_stream_start(sink->stream))
+        return 0;
+    if (!sink->open(sink))
+    {
+        audio_stream_stop(sink->stream);
+        return 0;
+    }
+    return 1;
+}
+
+static inline void audio_sink_stop(AudioSink *sink)
+{
+    sink->close(sink);
+    audio_stream_stop(sink->stream);
+}
+
+// Pull one period per period time on an absolute schedule, like a
+// device would. If the thread itself wakes up a period or more late the
+// schedule restarts from now and the slip is counted, instead of
+// draining the ring back to back and reporting scheduler jitter as
+// render underruns.
+static inline void *audio_clock_thread(void *arg)
+{
+    AudioSink *sink = (AudioSink *)arg;
+    AudioStream *s = sink->stream;
+    u64 period_ns = audio_period_ns(s);
+    u64 deadline = audio_now_ns();
+
+    while (__atomic_load_n(&sink->running, __ATOMIC_ACQUIRE))
+    {
+        deadline += period_ns;
+        u64 now = audio_now_ns();
+        if (deadline > now)
+        {
+            audio_sleep_ns(deadline - now);
+        }
+        else if (now - deadline >= period_ns)
+        {
+            s->stats.clock_slips++;
+            deadline = now;
+        }
+
+        audio_stream_read(s, sink->scratch, s->period);
+        if (sink->file)
+            fwrite(sink->scratch, sizeof(i16), (size_t)s->period, sink->file);
+        sink->frames_written += (u64)s->period;
+    }
+    return NULL;
+}
+
+static inline int audio_clock_open(AudioSink *sink)
+{
+    if (sink->file)
+        audio_wav_write_header(sink->file, sink->stream->sample_rate, 0);
+
+    __atomic_store_n(&sink->running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&sink->thread, NULL, audio_clock_thread, sink) != 0)
+    {
+        sink->running = 0;
+        return 0;
+    }
+    sink->thread_started = 1;
+    return 1;
+}
+
+static inline void audio_clock_close(AudioSink *sink)
+{
+    __atomic_store_n(&sink->running, 0, __ATOMIC_RELEASE);
+    if (sink->thread_started)
+    {
+        pthread_join(sink->thread, NULL);
+        sink->thread_started = 0;
+    }
+    if (sink->file)
+    {
+        fseek(sink->file, 0, SEEK_SET);
+        audio_wav_write_header(sink->file, sink->stream->sample_rate, (u32)sink->frames_written);
+        fclose(sink->file);
+        sink->file = NULL;
+    }
+}
+
+// Headless sink, discards audio but keeps device timing
+static inline void audio_sink_null(AudioSink *sink, AudioStream *stream)
+{
+    memset(sink, 0, sizeof(*sink));
+    sink->name = "null";
+    sink->stream = stream;
+    sink->open = audio_clock_open;
+    sink->close = audio_clock_close;
+}
+
+// Null sink that records the consumed audio to a WAV file.
+// Returns 0 if the file cannot be created.
+static inline int audio_sink_file(AudioSink *sink, AudioStream *stream, const char *path)
+{
+    audio_sink_null(sink, stream);
+    sink->name = "file";
+    sink->file = fopen(path, "wb");
+    return sink->file != NULL;
+}
+
+#ifdef MLWS_AUDIO_ALSA
+// Blocking writer thread, ALSA paces it at device rate
+static inline void *audio_alsa_thread(void *arg)
+{
+    AudioSink *sink = (AudioSink *)arg;
+    AudioStream *s = sink->stream;
+
+    while (__atomic_load_n(&sink->running, __ATOMIC_ACQUIRE))
+    {
+        audio_stream_read(s, sink->scratch, s->period);
+
+        // what is queued in the device plays before this period
+        snd_pcm_sframes_t delay;
+        if (snd_pcm_delay(sink->pcm, &delay) == 0 && delay >= 0)
+        {
+            u64 total = s->stats.latency_ns_last + (u64)delay * 1000000000ull / s->sample_rate;
+            s->stats.output_latency_count++;
+            s->stats.output_latency_ns_total += total;
+            if (total > s->stats.output_latency_ns_max)
+                s->stats.output_latency_ns_max = total;
+        }
+
+        int offset = 0;
+        while (offset < s->period)
+        {
+            snd_pcm_sframes_t written = snd_pcm_writei(sink->pcm, sink->scratch + offset,
+                                                       (snd_pcm_uframes_t)(s->period - offset));
+            if (written >= 0)
+            {
+                offset += (int)written; // short writes resume where they stopped
+                continue;
+            }
+
+            // device xrun, count it alongside ring underruns
+            s->stats.underruns++;
+            if (snd_pcm_recover(sink->pcm, (int)written, 1) < 0)
+            {
+                // unrecoverable (e.g. device unplugged), stop the sink
+                sink->failed = 1;
+                __atomic_store_n(&sink->running, 0, __ATOMIC_RELEASE);
+                return NULL;
+            }
+        }
+    }
+    return NULL;
+}
+
+static inline int audio_alsa_open(AudioSink *sink)
+{
+    AudioStream *s = sink->stream;
+    if (snd_pcm_open(&sink->pcm, sink->alsa_device, SND_PCM_STREAM_PLAYBACK, 0) < 0)
+        return 0;
+
+    // device side buffer matches the ring so total latency stays predictable
+    u32 latency_us = (u32)((u64)s->period * (u64)s->num_buffers * 1000000ull / s->sample_rate);
+    if (snd_pcm_set_params(sink->pcm, SND_PCM_FORMAT_S16, SND_PCM_ACCESS_RW_INTERLEAVED,
+                           1, s->sample_rate, 1, latency_us) < 0)
+    {
+        snd_pcm_close(sink->pcm);
+        return 0;
+    }
+
+    __atomic_store_n(&sink->running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&sink->thread, NULL, audio_alsa_thread, sink) != 0)
+    {
+        sink->running = 0;
+        snd_pcm_close(sink->pcm);
+        return 0;
+    }
+    sink->thread_started = 1;
+    return 1;
+}
+
+static inline void audio_alsa_close(AudioSink *sink)
+{
+    __atomic_store_n(&sink->running, 0, __ATOMIC_RELEASE);
+    if (sink->thread_started)
+    {
+        pthread_join(sink->thread, NULL);
+        sink->thread_started = 0;
+    }
+    if (sink->failed)
+        snd_pcm_drop(sink->pcm);
+    else
+        snd_pcm_drain(sink->pcm);
+    snd_pcm_close(sink->pcm);
+}
+
+// device is an ALSA PCM name, e.g. "default" or "hw:0,0"
+static inline void audio_sink_alsa(AudioSink *sink, AudioStream *stream, const char *device)
+{
+    memset(sink, 0, sizeof(*sink));
+    sink->name = "alsa";
+    sink->stream = stream;
+    sink->alsa_device = device;
+    sink->open = audio_alsa_open;
+    sink->close = audio_alsa_close;
+}
+#endif
+
+#ifdef MLWS_AUDIO_SDL
+// SDL device callback, only copies
+static inline void audio_sdl_callback(void *userdata, Uint8 *stream, int len)
+{
+    audio_stream_read((AudioStream *)userdata, (i16 *)stream, len / (int)sizeof(i16));
+}
+
+// SDL_INIT_AUDIO must be initialized by the caller
+static inline int audio_sdl_open(AudioSink *sink)
+{
+    AudioStream *s = sink->stream;
+    SDL_AudioSpec want, have;
+    SDL_zero(want);
+    want.freq = (int)s->sample_rate;
+    want.format = AUDIO_S16SYS; // 16-bit signed (need to force system endian)
+    want.channels = 1;          // Mono
+    want.samples = (Uint16)s->period;
+    want.callback = audio_sdl_callback;
+    want.userdata = s;
+
+    // no allowed changes, the ring is laid out for exactly this format
+    sink->sdl_device = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
+    if (sink->sdl_device == 0)
+        return 0;
+    SDL_PauseAudioDevice(sink->sdl_device, 0);
+    return 1;
+}
+
+static inline void audio_sdl_close(AudioSink *sink)
+{
+    if (sink->sdl_device != 0)
+    {
+        SDL_CloseAudioDevice(sink->sdl_device);
+        sink->sdl_device = 0;
+    }
+}
+
+static inline void audio_sink_sdl(AudioSink *sink, AudioStream *stream)
+{
+    memset(sink, 0, sizeof(*sink));
+    sink->name = "sdl";
+    sink->stream = stream;
+    sink->open = audio_sdl_open;
+    sink->close = audio_sdl_close;
+}
+#endif